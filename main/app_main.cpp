@@ -25,6 +25,10 @@
 #include <app/server/CommissioningWindowManager.h>
 #include <app/server/Server.h>
 
+#if CONFIG_DEINIT_BLE_ON_COMMISSIONING_COMPLETE
+#include <platform/internal/BLEManager.h>
+#endif
+
 static const char *TAG = "app_main";
 
 using namespace esp_matter;
@@ -34,6 +38,40 @@ using namespace chip::app::Clusters;
 
 constexpr auto k_timeout_seconds = 300;
 
+#if CONFIG_DEINIT_BLE_ON_COMMISSIONING_COMPLETE
+static bool s_ble_deinitialized = false;
+
+/* BLEMgr().Shutdown() stops the CHIPoBLE service and deinitializes the NimBLE host and
+ * controller, returning their heap. The static BT memory is kept for app_ble_reinit().
+ */
+static void app_ble_deinit(void)
+{
+    if (s_ble_deinitialized) {
+        return;
+    }
+
+    chip::DeviceLayer::Internal::BLEMgr().Shutdown();
+    s_ble_deinitialized = true;
+}
+
+static CHIP_ERROR app_ble_reinit(void)
+{
+    if (!s_ble_deinitialized) {
+        return CHIP_NO_ERROR;
+    }
+
+    /* BLEManager brings the NimBLE host and controller back up on its next state update */
+    CHIP_ERROR err = chip::DeviceLayer::Internal::BLEMgr().Init();
+    if (err != CHIP_NO_ERROR) {
+        ESP_LOGE(TAG, "Failed to reinit BLE, err:%" CHIP_ERROR_FORMAT, err.Format());
+        return err;
+    }
+
+    s_ble_deinitialized = false;
+    return CHIP_NO_ERROR;
+}
+#endif
+
 static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
 {
     switch (event->Type) {
@@ -43,6 +81,9 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
 
     case chip::DeviceLayer::DeviceEventType::kCommissioningComplete:
         ESP_LOGI(TAG, "Commissioning complete");
+#if CONFIG_DEINIT_BLE_ON_COMMISSIONING_COMPLETE
+        app_ble_deinit();
+#endif
         break;
 
     case chip::DeviceLayer::DeviceEventType::kFailSafeTimerExpired:
@@ -63,6 +104,12 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
 
     case chip::DeviceLayer::DeviceEventType::kCommissioningWindowClosed:
         ESP_LOGI(TAG, "Commissioning window closed");
+#if CONFIG_DEINIT_BLE_ON_COMMISSIONING_COMPLETE
+        /* Also release BLE when a reopened window times out without being commissioned */
+        if (chip::DeviceLayer::ConnectivityMgr().NumBLEConnections() == 0) {
+            app_ble_deinit();
+        }
+#endif
         break;
 
     case chip::DeviceLayer::DeviceEventType::kFabricRemoved:
@@ -74,11 +121,22 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
                 constexpr auto kTimeoutSeconds = chip::System::Clock::Seconds16(k_timeout_seconds);
                 if (!commissionMgr.IsCommissioningWindowOpen())
                 {
+#if CONFIG_DEINIT_BLE_ON_COMMISSIONING_COMPLETE
+                    /* BLE was released after commissioning, bring it back so that the device
+                     * can be commissioned again over BLE as well as DNS-SD. Fall back to
+                     * DNS-SD only if BLE cannot be brought up.
+                     */
+                    auto advertisement = (app_ble_reinit() == CHIP_NO_ERROR)
+                                             ? chip::CommissioningWindowAdvertisement::kAllSupported
+                                             : chip::CommissioningWindowAdvertisement::kDnssdOnly;
+                    CHIP_ERROR err = commissionMgr.OpenBasicCommissioningWindow(kTimeoutSeconds, advertisement);
+#else
                     /* After removing last fabric, this example does not remove the Wi-Fi credentials
                      * and still has IP connectivity so, only advertising on DNS-SD.
                      */
                     CHIP_ERROR err = commissionMgr.OpenBasicCommissioningWindow(kTimeoutSeconds,
                                                     chip::CommissioningWindowAdvertisement::kDnssdOnly);
+#endif
                     if (err != CHIP_NO_ERROR)
                     {
                         ESP_LOGE(TAG, "Failed to open commissioning window, err:%" CHIP_ERROR_FORMAT, err.Format());
@@ -193,6 +251,19 @@ extern "C" void app_main()
     err = esp_matter::start(app_event_cb);
     ABORT_APP_ON_FAILURE(err == ESP_OK, ESP_LOGE(TAG, "Failed to start Matter, err:%d", err));
 
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+    chip::DeviceLayer::PlatformMgr().ScheduleWork([](intptr_t) { sensor_set_endpoint_labels(); });
+#endif
+
+#if CONFIG_DEINIT_BLE_ON_COMMISSIONING_COMPLETE
+    /* Already commissioned devices do not need BLE after boot */
+    chip::DeviceLayer::PlatformMgr().ScheduleWork([](intptr_t) {
+        if (chip::Server::GetInstance().GetFabricTable().FabricCount() > 0) {
+            app_ble_deinit();
+        }
+    });
+#endif
+
     vTaskDelay(pdMS_TO_TICKS(5000));
     set_tx_power();
     
@@ -21,6 +21,11 @@ void sensor_init( void );
 void sensor_start( uint32_t interval_secs );
 void sensor_create_endpoints(node_t *node);
 
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+// tag the mean/min/max endpoints, must run on the Matter thread after esp_matter::start()
+void sensor_set_endpoint_labels( void );
+#endif
+
 #if CHIP_DEVICE_CONFIG_ENABLE_THREAD
 #include "esp_openthread_types.h"
 #endif
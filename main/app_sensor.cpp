@@ -5,11 +5,19 @@
 #include <esp_matter.h>
 
 #include <string.h>
+#include <math.h>
+
+#include <esp_rom_sys.h>
 
 #include <common_macros.h>
+#include <app_priv.h>
 
 #include <sht4x.h>
 
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+#include <app/util/attribute-storage.h>
+#endif
+
 //#define CONFIG_BATT_LEVEL_USED
 
 #if defined(CONFIG_BATT_LEVEL_USED)
@@ -41,11 +49,19 @@ typedef struct {
     struct {
         sensor_cb_t cb = NULL;  // This callback functon will be called periodically to report the temperature.
         uint16_t endpoint_id;   // endpoint_id associated with temperature sensor
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+        uint16_t min_endpoint_id;   // endpoint_id reporting the per-period minimum
+        uint16_t max_endpoint_id;   // endpoint_id reporting the per-period maximum
+#endif
     } temperature;
 
     struct {
         sensor_cb_t cb = NULL;  // This callback functon will be called periodically to report the humidity.
         uint16_t endpoint_id;   // endpoint_id associated with humidity sensor
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+        uint16_t min_endpoint_id;   // endpoint_id reporting the per-period minimum
+        uint16_t max_endpoint_id;   // endpoint_id reporting the per-period maximum
+#endif
     } humidity;
 
     struct {
@@ -75,6 +91,18 @@ typedef struct {
 #endif    
 } sensor_ctx_t;
 
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+// aggregate of one burst, in 0.01 units (°C or %) as used by the Matter measurement clusters
+typedef struct {
+    int32_t mean;
+    int32_t min;
+    int32_t max;
+} sensor_aggregate_t;
+
+// SHT4x worst case low repeatability conversion time is 1.6 ms
+#define SHT4X_LOW_MEASUREMENT_US    1700
+#endif
+
 static constexpr char *TAG_SENSOR = "sensor";
 
 using namespace esp_matter;
@@ -88,6 +116,9 @@ static sensor_ctx_t s_ctx;
 static void temp_sensor_notification(uint16_t endpoint_id, float temp, void *user_data);
 static void humidity_sensor_notification(uint16_t endpoint_id, float humidity, void *user_data);
 void sensor_get( float *temperature, float *humidity );
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+static esp_err_t sensor_get_burst( sensor_aggregate_t *temperature, sensor_aggregate_t *humidity );
+#endif
 #if defined(CONFIG_BATT_LEVEL_USED)
 
 
@@ -159,6 +190,21 @@ void sensor_timer_callback(void *arg)
   }
   #endif
 
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+  sensor_aggregate_t temp_agg, humidity_agg;
+  if (sensor_get_burst(&temp_agg, &humidity_agg) == ESP_OK) {
+    if (ctx->config.temperature.cb) {
+      ctx->config.temperature.cb(ctx->config.temperature.endpoint_id, temp_agg.mean / 100.0f, ctx->config.user_data);
+      ctx->config.temperature.cb(ctx->config.temperature.min_endpoint_id, temp_agg.min / 100.0f, ctx->config.user_data);
+      ctx->config.temperature.cb(ctx->config.temperature.max_endpoint_id, temp_agg.max / 100.0f, ctx->config.user_data);
+    }
+    if (ctx->config.humidity.cb) {
+      ctx->config.humidity.cb(ctx->config.humidity.endpoint_id, humidity_agg.mean / 100.0f, ctx->config.user_data);
+      ctx->config.humidity.cb(ctx->config.humidity.min_endpoint_id, humidity_agg.min / 100.0f, ctx->config.user_data);
+      ctx->config.humidity.cb(ctx->config.humidity.max_endpoint_id, humidity_agg.max / 100.0f, ctx->config.user_data);
+    }
+  }
+#else
   float temp, humidity;
   sensor_get(&temp, &humidity);
 
@@ -168,6 +214,7 @@ void sensor_timer_callback(void *arg)
   if (ctx->config.humidity.cb) {
     ctx->config.humidity.cb(ctx->config.humidity.endpoint_id, humidity, ctx->config.user_data);
   }
+#endif
 
 #if defined(CONFIG_BATT_LEVEL_USED)
 
@@ -206,6 +253,81 @@ void sensor_get( float *temperature, float *humidity )
     ESP_LOGI(TAG_SENSOR,"sht4x Sensor: %.2f °C, %.2f %%\n", *temperature, *humidity);
 }
 
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+// SHT4x datasheet, 4.6 Conversion of Signal Output, scaled to 0.01 units
+// T = -45 + 175 * ticks / 65535, RH = -6 + 125 * ticks / 65535 (clamped to 0..100 %)
+static int32_t sht4x_ticks_to_centi_celsius(uint16_t ticks)
+{
+    return -4500 + static_cast<int32_t>((17500u * ticks + 32767u) / 65535u);
+}
+
+static int32_t sht4x_ticks_to_centi_percent(uint16_t ticks)
+{
+    int32_t rh = -600 + static_cast<int32_t>((12500u * ticks + 32767u) / 65535u);
+    if (rh < 0) rh = 0;
+    if (rh > 10000) rh = 10000;
+    return rh;
+}
+
+static void sensor_aggregate_add(sensor_aggregate_t *agg, int32_t *sum, int32_t value, bool first)
+{
+    if (first || value < agg->min) agg->min = value;
+    if (first || value > agg->max) agg->max = value;
+    *sum += value;
+}
+
+// rounded division, half away from zero
+static int32_t sensor_div_round(int32_t sum, int32_t count)
+{
+    return (sum >= 0) ? (sum + count / 2) / count : (sum - count / 2) / count;
+}
+
+// Take CONFIG_SENSOR_BURST_SAMPLES low repeatability samples in one wake and reduce them to mean/min/max
+static esp_err_t sensor_get_burst( sensor_aggregate_t *temperature, sensor_aggregate_t *humidity )
+{
+    sht4x_repeat_t repeatability = s_ctx.dev.repeatability;
+    s_ctx.dev.repeatability = SHT4X_LOW;
+
+    int32_t temp_sum = 0, humidity_sum = 0;
+    int32_t count = 0;
+
+    for (int i = 0; i < CONFIG_SENSOR_BURST_SAMPLES; i++) {
+        sht4x_raw_data_t raw;
+        esp_err_t err = sht4x_start_measurement(&s_ctx.dev);
+        if (err == ESP_OK) {
+            // busy-wait the conversion, a tick based delay can be shorter than 1.6 ms
+            esp_rom_delay_us(SHT4X_LOW_MEASUREMENT_US);
+            err = sht4x_get_raw_data(&s_ctx.dev, raw);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG_SENSOR, "burst sample %d failed: %s", i, esp_err_to_name(err));
+            continue;
+        }
+
+        int32_t temp = sht4x_ticks_to_centi_celsius(((uint16_t)raw[0] << 8) | raw[1]);
+        int32_t rh = sht4x_ticks_to_centi_percent(((uint16_t)raw[3] << 8) | raw[4]);
+        sensor_aggregate_add(temperature, &temp_sum, temp, count == 0);
+        sensor_aggregate_add(humidity, &humidity_sum, rh, count == 0);
+        count++;
+    }
+
+    s_ctx.dev.repeatability = repeatability;
+
+    if (count == 0) {
+        ESP_LOGE(TAG_SENSOR, "sht4x burst: no valid samples");
+        return ESP_FAIL;
+    }
+
+    temperature->mean = sensor_div_round(temp_sum, count);
+    humidity->mean = sensor_div_round(humidity_sum, count);
+
+    ESP_LOGI(TAG_SENSOR, "sht4x burst(%ld): T %ld [%ld..%ld], RH %ld [%ld..%ld] (x0.01)", (long)count,
+             (long)temperature->mean, (long)temperature->min, (long)temperature->max,
+             (long)humidity->mean, (long)humidity->min, (long)humidity->max);
+    return ESP_OK;
+}
+#endif
+
 // Application cluster specification, 7.18.2.11. Temperature
 // represents a temperature on the Celsius scale with a resolution of 0.01°C.
 // temp = (temperature in °C) x 100
@@ -219,7 +341,7 @@ static void temp_sensor_notification(uint16_t endpoint_id, float temp, void *use
 
         esp_matter_attr_val_t val = esp_matter_invalid(NULL);
         attribute::get_val(attribute, &val);
-        val.val.i16 = static_cast<int16_t>(temp * 100);
+        val.val.i16 = static_cast<int16_t>(lroundf(temp * 100));
 
         attribute::update(endpoint_id, TemperatureMeasurement::Id, TemperatureMeasurement::Attributes::MeasuredValue::Id, &val);
     });
@@ -238,7 +360,7 @@ static void humidity_sensor_notification(uint16_t endpoint_id, float humidity, v
 
         esp_matter_attr_val_t val = esp_matter_invalid(NULL);
         attribute::get_val(attribute, &val);
-        val.val.u16 = static_cast<uint16_t>(humidity * 100);
+        val.val.u16 = static_cast<uint16_t>(lroundf(humidity * 100));
 
         attribute::update(endpoint_id, RelativeHumidityMeasurement::Id, RelativeHumidityMeasurement::Attributes::MeasuredValue::Id, &val);
     });
@@ -359,6 +481,35 @@ static void create_battery_endpoint(node_t *node)
 
 #endif
 
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+// Descriptor TagList entries telling the mean, min and max endpoints apart.
+// Common Number namespace (0x07), tag = statistic, label = human readable name.
+using SemanticTag = Descriptor::Structs::SemanticTagStruct::Type;
+
+static SemanticTag make_statistic_tag(uint8_t tag, const char *label)
+{
+    SemanticTag semantic_tag;
+    semantic_tag.namespaceID = 0x07;
+    semantic_tag.tag = tag;
+    semantic_tag.label.SetValue(chip::app::DataModel::MakeNullable(chip::CharSpan::fromCharString(label)));
+    return semantic_tag;
+}
+
+void sensor_set_endpoint_labels( void )
+{
+    static const SemanticTag mean_tags[] = { make_statistic_tag(0, "Mean") };
+    static const SemanticTag min_tags[] = { make_statistic_tag(1, "Minimum") };
+    static const SemanticTag max_tags[] = { make_statistic_tag(2, "Maximum") };
+
+    SetTagList(s_ctx.config.temperature.endpoint_id, chip::Span<const SemanticTag>(mean_tags));
+    SetTagList(s_ctx.config.temperature.min_endpoint_id, chip::Span<const SemanticTag>(min_tags));
+    SetTagList(s_ctx.config.temperature.max_endpoint_id, chip::Span<const SemanticTag>(max_tags));
+    SetTagList(s_ctx.config.humidity.endpoint_id, chip::Span<const SemanticTag>(mean_tags));
+    SetTagList(s_ctx.config.humidity.min_endpoint_id, chip::Span<const SemanticTag>(min_tags));
+    SetTagList(s_ctx.config.humidity.max_endpoint_id, chip::Span<const SemanticTag>(max_tags));
+}
+#endif
+
 void sensor_create_endpoints(node_t *node)
 {
     // add temperature sensor device
@@ -380,4 +531,29 @@ void sensor_create_endpoints(node_t *node)
     #if defined(CONFIG_BATT_LEVEL_USED)
     create_battery_endpoint(node);
     #endif
+
+#if CONFIG_SENSOR_BURST_SAMPLES > 1
+    // per-period min/max of the burst aggregate are reported on their own endpoints, created last
+    // so that the ids of the other endpoints do not depend on CONFIG_SENSOR_BURST_SAMPLES
+    endpoint_t * temp_min_ep = temperature_sensor::create(node, &temp_sensor_config, ENDPOINT_FLAG_NONE, NULL);
+    endpoint_t * temp_max_ep = temperature_sensor::create(node, &temp_sensor_config, ENDPOINT_FLAG_NONE, NULL);
+    ABORT_APP_ON_FAILURE(temp_min_ep != nullptr && temp_max_ep != nullptr, ESP_LOGE(TAG_SENSOR, "Failed to create temperature min/max endpoints"));
+
+    s_ctx.config.temperature.min_endpoint_id = endpoint::get_id(temp_min_ep);
+    s_ctx.config.temperature.max_endpoint_id = endpoint::get_id(temp_max_ep);
+
+    endpoint_t * humidity_min_ep = humidity_sensor::create(node, &humidity_sensor_config, ENDPOINT_FLAG_NONE, NULL);
+    endpoint_t * humidity_max_ep = humidity_sensor::create(node, &humidity_sensor_config, ENDPOINT_FLAG_NONE, NULL);
+    ABORT_APP_ON_FAILURE(humidity_min_ep != nullptr && humidity_max_ep != nullptr, ESP_LOGE(TAG_SENSOR, "Failed to create humidity min/max endpoints"));
+
+    s_ctx.config.humidity.min_endpoint_id = endpoint::get_id(humidity_min_ep);
+    s_ctx.config.humidity.max_endpoint_id = endpoint::get_id(humidity_max_ep);
+
+    cluster::descriptor::feature::taglist::add(cluster::get(temp_sensor_ep, Descriptor::Id));
+    cluster::descriptor::feature::taglist::add(cluster::get(temp_min_ep, Descriptor::Id));
+    cluster::descriptor::feature::taglist::add(cluster::get(temp_max_ep, Descriptor::Id));
+    cluster::descriptor::feature::taglist::add(cluster::get(humidity_sensor_ep, Descriptor::Id));
+    cluster::descriptor::feature::taglist::add(cluster::get(humidity_min_ep, Descriptor::Id));
+    cluster::descriptor::feature::taglist::add(cluster::get(humidity_max_ep, Descriptor::Id));
+#endif
 }
\ No newline at end of file